@@ -0,0 +1,272 @@
+// Protocol checks for the headless server (--serve). Needs no SFML; POSIX only.
+//
+// Scripted batches are piped through runServer on stdin and the replies compared with the
+// expected output, with the microseconds field of each OK line masked. A second server on a
+// Unix socket checks that a client which never reads its replies does not stall another one.
+
+#include "../include/server.h"
+#include "../include/tilemap.h"
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int failures = 0;
+
+void expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+// "OK 2 1 537" -> "OK 2 1 *"
+std::string maskTimings(const std::string& replies) {
+    std::istringstream in(replies);
+    std::string line, out;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 3, "OK ") == 0)
+            line = line.substr(0, line.rfind(' ')) + " *";
+        out += line + "\n";
+    }
+    return out;
+}
+
+// Runs the server in a child process with input as its stdin and returns what it printed
+std::string serveScript(const ServeOptions& options, const std::string& input, int& exitCode) {
+    const char* inputPath = "server_check.in";
+    std::ofstream(inputPath, std::ios::binary) << input;
+
+    int out[2];
+    if (::pipe(out) < 0)
+        return "";
+    std::fflush(stdout);
+    pid_t child = ::fork();
+    if (child == 0) {
+        int in = ::open(inputPath, O_RDONLY);
+        if (in < 0 || ::dup2(in, STDIN_FILENO) < 0 || ::dup2(out[1], STDOUT_FILENO) < 0)
+            ::_exit(2);
+        ::close(out[0]);
+        ::_exit(runServer(options) == 0 ? 0 : 1);
+    }
+    ::close(out[1]);
+
+    std::string replies;
+    char buffer[64 * 1024];
+    ssize_t n;
+    while ((n = ::read(out[0], buffer, sizeof(buffer))) > 0 || (n < 0 && errno == EINTR))
+        if (n > 0)
+            replies.append(buffer, static_cast<std::size_t>(n));
+    ::close(out[0]);
+
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    std::remove(inputPath);
+    return replies;
+}
+
+void checkScript(const char* what, const ServeOptions& options, const std::string& input,
+                 const std::string& expected) {
+    int exitCode = 0;
+    std::string replies = maskTimings(serveScript(options, input, exitCode));
+    expect(exitCode == 0, what);
+    if (replies != expected) {
+        std::printf("FAIL: %s\n--- expected\n%s--- got\n%s---\n", what, expected.c_str(), replies.c_str());
+        ++failures;
+    }
+}
+
+void checkBatches() {
+    ServeOptions options;
+    options.width = 10;
+    options.height = 10;
+    options.expandLimit = 50;
+
+    checkScript("batched edits, queries and errors", options,
+        "W 3 0\n"
+        "E 3 0\n"                   // last edit to a cell wins
+        "W 3 1\n"
+        "Q bfs 0 0 4 0\n"
+        "Q astar 0 0 3 1\n"         // made a wall by this batch's edits
+        "SAVE\n"                    // in-memory map
+        "Q dfs 0 0 99 0\n"
+        "X 1 2\n"
+        "W 3 3 extra\n"
+        "SAVE now\n"
+        "\n"
+        "Q bfs 0 0 9 9\n"           // needs more than 50 expansions
+        "\n"
+        "Q astar 0 0 2 0\n",        // no blank line: answered at end of input
+        "P 11 5 0 0 1 0 2 0 3 0 4 0\n"
+        "ERR 5 endpoint is a wall\n"
+        "ERR 6 map is not file-backed\n"
+        "ERR 7 cell out of bounds\n"
+        "ERR 8 unknown command X\n"
+        "ERR 9 expected: W x y\n"
+        "ERR 10 expected: SAVE\n"
+        "OK 2 1 *\n"
+        "L 50\n"
+        "OK 1 0 *\n"
+        "P 3 3 0 0 1 0 2 0\n"
+        "OK 1 0 *\n");
+}
+
+void checkSave() {
+    const char* path = "server_check.pftm";
+    std::remove(path);
+
+    ServeOptions options;
+    options.mapPath = path;
+    options.width = 300;
+    options.height = 300;
+    options.cacheTiles = 1;
+
+    checkScript("SAVE on a file-backed map", options,
+        "W 1 1\nW 200 1\nW 1 200\n\nSAVE\n\n",
+        "OK 0 3 *\n"
+        "SAVED\n"
+        "OK 0 0 *\n");
+
+    TileMap reopened;
+    expect(reopened.open(path, 4), "reopen saved map");
+    expect(reopened.isWall(1, 1) && reopened.isWall(200, 1) && reopened.isWall(1, 200)
+           && !reopened.isWall(2, 2), "saved edits are on disk");
+    std::remove(path);
+}
+
+void checkBatchCap() {
+    ServeOptions options;
+    options.width = 10;
+    options.height = 10;
+
+    std::string input;
+    for (int i = 0; i < 65537; ++i)
+        input += "Q bfs 0 0 0 0\n";
+    input += "\n";
+
+    int exitCode = 0;
+    std::string replies = maskTimings(serveScript(options, input, exitCode));
+    const std::string cutOff = "ERR 65536 batch too long, ended here\nOK 65536 0 *\n";
+    const std::string rest = "P 1 1 0 0\nOK 1 0 *\n";
+    expect(exitCode == 0, "batch cap run");
+    expect(replies.size() > cutOff.size() + rest.size()
+           && replies.compare(replies.size() - cutOff.size() - rest.size(), std::string::npos, cutOff + rest) == 0,
+           "a batch without a blank line is ended at the cap");
+}
+
+int connectTo(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, path.c_str());
+
+    auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (Clock::now() < deadline) {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0)
+            return fd;
+        ::close(fd);
+        ::usleep(10 * 1000);
+    }
+    return -1;
+}
+
+// Reads until `count` OK lines have arrived or the timeout passes; returns how many did
+int readReplies(int fd, int count, int timeoutMs, std::string& replies) {
+    auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    int seen = 0;
+    std::size_t scanned = 0;
+    char buffer[64 * 1024];
+    while (seen < count) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        pollfd pfd{ fd, POLLIN, 0 };
+        if (left <= 0 || ::poll(&pfd, 1, static_cast<int>(left)) <= 0)
+            break;
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n <= 0)
+            break;
+        replies.append(buffer, static_cast<std::size_t>(n));
+        std::size_t end;
+        while ((end = replies.find('\n', scanned)) != std::string::npos) {
+            if (replies.compare(scanned, 3, "OK ") == 0)
+                ++seen;
+            scanned = end + 1;
+        }
+    }
+    return seen;
+}
+
+void checkSlowReader() {
+    const std::string socketPath = "server_check.sock";
+    ServeOptions options;
+    options.width = 2000;
+    options.height = 2000;
+    options.socketPath = socketPath;
+
+    std::fflush(stdout);
+    pid_t child = ::fork();
+    if (child == 0)
+        ::_exit(runServer(options) == 0 ? 0 : 1);
+
+    // Client A pipelines ~18 MB worth of replies and doesn't read any of them
+    const int floodBatches = 4000;
+    int flood = connectTo(socketPath);
+    expect(flood >= 0, "connect flooding client");
+    std::string request;
+    for (int i = 0; i < floodBatches; ++i)
+        request += "Q astar 0 0 499 0\n\n";
+    std::size_t sent = 0;
+    while (flood >= 0 && sent < request.size()) {
+        ssize_t n = ::write(flood, request.data() + sent, request.size() - sent);
+        if (n <= 0)
+            break;
+        sent += static_cast<std::size_t>(n);
+    }
+    expect(sent == request.size(), "flooding client's requests fit in the socket buffers");
+
+    // Client B must still get a prompt answer
+    int other = connectTo(socketPath);
+    expect(other >= 0, "connect second client");
+    const char* query = "Q astar 0 0 3 0\n\n";
+    expect(::write(other, query, std::strlen(query)) == static_cast<ssize_t>(std::strlen(query)), "second client sends");
+    std::string replies;
+    expect(readReplies(other, 1, 2000, replies) == 1, "second client is answered while the first doesn't read");
+    expect(maskTimings(replies) == "P 4 4 0 0 1 0 2 0 3 0\nOK 1 0 *\n", "second client's reply");
+    ::close(other);
+
+    // Nothing was dropped for the slow client, it was only held back
+    replies.clear();
+    expect(readReplies(flood, floodBatches, 20000, replies) == floodBatches, "flooding client gets every reply once it reads");
+    ::close(flood);
+
+    ::kill(child, SIGTERM);
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    expect(WIFEXITED(status) && WEXITSTATUS(status) == 0, "server exits cleanly on SIGTERM");
+    expect(::access(socketPath.c_str(), F_OK) != 0, "server removes its socket on SIGTERM");
+}
+
+} // namespace
+
+int main() {
+    checkBatches();
+    checkSave();
+    checkBatchCap();
+    checkSlowReader();
+    std::printf("server checks: %s\n", failures == 0 ? "passed" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,346 @@
+// TileMap checks and benchmarks against a dense byte-per-cell layout. Needs no SFML.
+//
+//   tilemap_bench           run the checks, then the memory/throughput benchmarks
+//   tilemap_bench --check   run the checks only (used by ctest)
+
+#include "../include/pathfinder.h"
+#include "../include/tilemap.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millisSince(Clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+}
+
+// Dense reference layout: one byte per cell, row-major
+struct DenseMap {
+    int width, height;
+    std::vector<std::uint8_t> cells;
+
+    DenseMap(int w, int h) : width(w), height(h), cells(static_cast<std::size_t>(w) * h) {}
+    bool isWall(int x, int y) const {
+        return x < 0 || y < 0 || x >= width || y >= height
+            || cells[static_cast<std::size_t>(y) * width + x];
+    }
+};
+
+// Shortest path length on the dense map, -1 if unreachable
+int denseBfs(const DenseMap& map, Cell start, Cell goal) {
+    if (map.isWall(start.x, start.y) || map.isWall(goal.x, goal.y))
+        return -1;
+
+    static const int dx[4] = { 0, -1, 1, 0 };
+    static const int dy[4] = { -1, 0, 0, 1 };
+    std::vector<int> dist(map.cells.size(), -1);
+    std::queue<Cell> q;
+    dist[static_cast<std::size_t>(start.y) * map.width + start.x] = 0;
+    q.push(start);
+
+    while (!q.empty()) {
+        Cell c = q.front();
+        q.pop();
+        int d = dist[static_cast<std::size_t>(c.y) * map.width + c.x];
+        if (c == goal)
+            return d;
+        for (int i = 0; i < 4; ++i) {
+            int nx = c.x + dx[i], ny = c.y + dy[i];
+            if (map.isWall(nx, ny))
+                continue;
+            int& nd = dist[static_cast<std::size_t>(ny) * map.width + nx];
+            if (nd < 0) {
+                nd = d + 1;
+                q.push({ nx, ny });
+            }
+        }
+    }
+    return -1;
+}
+
+bool isValidPath(const SearchResult& result, TileMap& map, Cell start, Cell goal) {
+    if (result.path.empty() || result.path.front() != start || result.path.back() != goal)
+        return false;
+    for (std::size_t i = 0; i < result.path.size(); ++i) {
+        const Cell& c = result.path[i];
+        if (map.isWall(c.x, c.y))
+            return false;
+        if (i > 0 && std::abs(c.x - result.path[i - 1].x) + std::abs(c.y - result.path[i - 1].y) != 1)
+            return false;
+    }
+    return true;
+}
+
+int failures = 0;
+
+void expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+void checkAgainstDense() {
+    const int W = 700, H = 500;
+    const std::string path = "tilemap_check.pftm";
+    std::mt19937 rng(1);
+
+    DenseMap dense(W, H);
+    TileMap memory(W, H);
+    {
+        TileMap disk;
+        expect(disk.create(path, W, H, 3), "create file-backed map");
+
+        // Random walls, a solid block spanning whole tiles, and an open corridor
+        for (int y = 0; y < H; ++y) {
+            for (int x = 0; x < W; ++x) {
+                bool wall = (x >= 320 && x < 384 && y < 300)
+                    || (!(x >= 64 && x < 128) && rng() % 100 < 28);
+                dense.cells[static_cast<std::size_t>(y) * W + x] = wall;
+                memory.setWall(x, y, wall);
+                disk.setWall(x, y, wall);
+            }
+        }
+        expect(memory.getTileKind(5, 0) == TileKind::WALL, "uniform wall tile folds back to shared");
+        expect(disk.residentTiles() <= 3, "file-backed cache stays within capacity");
+        expect(disk.flush(), "flush file-backed map");
+    }
+
+    TileMap reopened;
+    expect(reopened.open(path, 5), "reopen file-backed map");
+
+    Pathfinder inMemory(memory), fromDisk(reopened);
+    const Algorithm algorithms[] = { Algorithm::ASTAR, Algorithm::DIJKSTRA, Algorithm::BFS, Algorithm::DFS };
+    for (int i = 0; i < 80; ++i) {
+        Cell start{ static_cast<int>(rng() % W), static_cast<int>(rng() % H) };
+        Cell goal{ static_cast<int>(rng() % W), static_cast<int>(rng() % H) };
+        int reference = denseBfs(dense, start, goal);
+
+        for (Algorithm algorithm : algorithms) {
+            SearchResult a, b;
+            bool foundA = inMemory.run(algorithm, start, goal, a);
+            bool foundB = fromDisk.run(algorithm, start, goal, b);
+            expect(foundA == (reference >= 0) && foundB == (reference >= 0), "reachability matches dense BFS");
+            if (!foundA || !foundB)
+                continue;
+            expect(isValidPath(a, memory, start, goal) && isValidPath(b, reopened, start, goal), "path is connected and wall-free");
+            // DFS finds a path, not necessarily a shortest one
+            if (algorithm != Algorithm::DFS)
+                expect(static_cast<int>(a.path.size()) - 1 == reference
+                    && static_cast<int>(b.path.size()) - 1 == reference, "path length matches dense BFS");
+        }
+    }
+    expect(reopened.residentTiles() <= 5, "reopened cache stays within capacity");
+
+    // Editing a tile back to uniform drops its private copy
+    TileMap folding(256, 256);
+    folding.setWall(10, 10, true);
+    expect(folding.residentTiles() == 1, "edit copies the shared tile");
+    folding.setWall(10, 10, false);
+    expect(folding.residentTiles() == 0 && folding.getTileKind(0, 0) == TileKind::EMPTY, "edit back folds the tile");
+
+    // Truncated files are rejected up front
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::string head(1000, '\0');
+        in.read(&head[0], static_cast<std::streamsize>(head.size()));
+        std::ofstream out("tilemap_check_truncated.pftm", std::ios::binary | std::ios::trunc);
+        out.write(head.data(), in.gcount());
+    }
+    TileMap truncated;
+    expect(!truncated.open("tilemap_check_truncated.pftm", 4), "truncated file is rejected");
+
+    std::remove(path.c_str());
+    std::remove("tilemap_check_truncated.pftm");
+}
+
+#ifndef _WIN32
+void checkCrashConsistency() {
+    // A process killed before flush() must leave every tile in its old or new state
+    const char* path = "tilemap_crash.pftm";
+    {
+        TileMap map;
+        expect(map.create(path, 512, 64, 1), "create crash-test map");
+    }
+
+    pid_t child = ::fork();
+    if (child == 0) {
+        TileMap map;
+        if (!map.open(path, 1))
+            ::_exit(1);
+        map.setWall(10, 10, true);    // tile 0 becomes mixed
+        map.setWall(100, 10, true);   // tile 1 becomes mixed, evicting tile 0
+        map.setWall(200, 10, true);   // tile 3 becomes mixed, evicting tile 1
+        map.setWall(100, 10, false);  // tile 1 folds back to empty
+        ::_exit(0);                   // no destructors, no flush: like kill -9
+    }
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    expect(WIFEXITED(status) && WEXITSTATUS(status) == 0, "crash-test child ran");
+
+    TileMap reopened;
+    expect(reopened.open(path, 4), "reopen after crash");
+    expect(reopened.isWall(10, 10), "evicted new mixed tile survives a crash");
+    expect(!reopened.isWall(100, 10), "folded tile stays folded after a crash");
+    std::remove(path);
+}
+#endif
+
+void checkTieBreak() {
+    // Equal-f ties must go to the deeper entry, or open ground expands the whole bounding box
+    TileMap open(1000, 1000);
+    open.setWall(500, 3, true);
+    Pathfinder pathfinder(open);
+    SearchResult result;
+    expect(pathfinder.run(Algorithm::ASTAR, { 0, 0 }, { 999, 999 }, result), "A* crosses open ground");
+    expect(result.path.size() == 1999 && result.expanded < 4000, "A* on open ground expands about one path's worth");
+}
+
+void checkWarmBuffers() {
+    // One large search must not slow down every small query that follows it
+    SearchResult result;
+    TileMap big(3000, 3000);
+    Pathfinder warm(big);
+    auto smallQueries = [&] {
+        auto begin = Clock::now();
+        for (int i = 0; i < 2000; ++i) {
+            Cell start{ 10 + i % 100, 10 + i / 100 };
+            warm.run(Algorithm::ASTAR, start, { start.x + 5, start.y + 3 }, result);
+        }
+        return millisSince(begin);
+    };
+    double before = smallQueries();
+    warm.setExpandLimit(1000000);
+    warm.run(Algorithm::BFS, { 0, 0 }, { 2999, 2999 }, result);
+    expect(result.limitReached, "large BFS stops at the expansion limit");
+    double after = smallQueries();
+    std::printf("2000 small A* queries: %.1f ms before a 1M-expansion BFS, %.1f ms after\n", before, after);
+    expect(after < before * 10 + 20, "small queries stay fast after a large one");
+}
+
+void addWallSegments(TileMap& map, std::mt19937& rng, int count) {
+    const int n = map.getWidth();
+    for (int k = 0; k < count; ++k) {
+        int x = static_cast<int>(rng() % (n - 300));
+        int y = static_cast<int>(rng() % (n - 20));
+        for (int j = 0; j < 10; ++j)
+            for (int i = 0; i < 300; ++i)
+                map.setWall(x + i, y + j, true);
+    }
+}
+
+void benchSparseWorld() {
+    const int N = 100000;
+    std::mt19937 rng(2);
+
+    TileMap map(N, N);
+    auto begin = Clock::now();
+    addWallSegments(map, rng, 2000);
+    std::printf("100k x 100k, 2000 wall segments: built in %.0f ms, %zu resident tiles, %.2f MB "
+                "(dense 1 byte/cell: %.1f GB)\n",
+                millisSince(begin), map.residentTiles(), map.memoryBytes() / 1e6,
+                static_cast<double>(N) * N / 1e9);
+
+    Pathfinder pathfinder(map);
+    SearchResult result;
+    std::size_t expanded = 0;
+    int found = 0;
+    begin = Clock::now();
+    for (int i = 0; i < 50; ++i) {
+        Cell start{ static_cast<int>(rng() % (N - 1000)), static_cast<int>(rng() % (N - 1000)) };
+        Cell goal{ start.x + static_cast<int>(rng() % 1000), start.y + static_cast<int>(rng() % 1000) };
+        found += pathfinder.run(Algorithm::ASTAR, start, goal, result);
+        expanded += result.expanded;
+    }
+    double elapsed = millisSince(begin);
+    std::printf("  A* endpoints <= 1000 apart: %d/50 found, %.2f ms/query, %.2f M expansions/s\n",
+                found, elapsed / 50, expanded / elapsed / 1e3);
+
+    const std::string path = "tilemap_bench.pftm";
+    {
+        TileMap disk;
+        if (disk.create(path, N, N, 256)) {
+            addWallSegments(disk, rng, 2000);
+            disk.flush();
+            std::printf("  file-backed, 256-tile cache: %zu resident tiles, %.2f MB\n",
+                        disk.residentTiles(), disk.memoryBytes() / 1e6);
+        }
+    }
+    std::remove(path.c_str());
+}
+
+void benchDenseComparison() {
+    const int W = 4096, H = 4096;
+    std::mt19937 rng(3);
+
+    DenseMap dense(W, H);
+    TileMap map(W, H);
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            bool wall = rng() % 100 < 20;
+            dense.cells[static_cast<std::size_t>(y) * W + x] = wall;
+            if (wall)
+                map.setWall(x, y, true);
+        }
+    }
+    std::printf("4096 x 4096, 20%% random walls: dense %.1f MB, tiled %.1f MB\n",
+                dense.cells.size() / 1e6, map.memoryBytes() / 1e6);
+
+    // Row-order neighbour scans over the top quarter, the access pattern a flood fill approaches
+    static const int dx[4] = { 0, -1, 1, 0 };
+    static const int dy[4] = { -1, 0, 0, 1 };
+    const double cells = static_cast<double>(W) * (H / 4);
+    long open = 0;
+
+    auto begin = Clock::now();
+    for (int y = 0; y < H / 4; ++y)
+        for (int x = 0; x < W; ++x)
+            for (int i = 0; i < 4; ++i)
+                open += !dense.isWall(x + dx[i], y + dy[i]);
+    double denseMs = millisSince(begin);
+
+    TileCursor cursor(map);
+    Cell out[4];
+    begin = Clock::now();
+    for (int y = 0; y < H / 4; ++y)
+        for (int x = 0; x < W; ++x)
+            open -= cursor.neighbours({ x, y }, out);
+    double tiledMs = millisSince(begin);
+
+    std::printf("  neighbour scans: dense %.1f M cells/s, TileCursor %.1f M cells/s%s\n",
+                cells / denseMs / 1e3, cells / tiledMs / 1e3, open == 0 ? "" : " (MISMATCH)");
+    expect(open == 0, "TileCursor agrees with the dense layout");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool checkOnly = argc > 1 && std::string(argv[1]) == "--check";
+
+    checkAgainstDense();
+#ifndef _WIN32
+    checkCrashConsistency();
+#endif
+    checkTieBreak();
+    checkWarmBuffers();
+    std::printf("checks: %s\n", failures == 0 ? "passed" : "FAILED");
+    if (checkOnly || failures)
+        return failures == 0 ? 0 : 1;
+
+    benchSparseWorld();
+    benchDenseComparison();
+    return failures == 0 ? 0 : 1;
+}
@@ -13,8 +13,12 @@ public:
     void setSelected(bool selected);       // Set selected state
     void updateAppearance();               // Update color based on state
 
+    bool isDirty() const { return dirty; } // Appearance changed since last frame
+    void markClean() { dirty = false; }
+
 private:
     sf::RectangleShape shape;
     sf::Text text;
     bool isSelected = false;
+    bool dirty = true;
 };
@@ -10,7 +10,15 @@ class Grid {
 public:
     Grid(int rows, int cols, int windowWidth, int windowHeight);
 
-    void draw(sf::RenderWindow& window) const;
+    // Nodes point at dirtyNodes and canvasSprite at canvas, so a Grid must stay put
+    Grid(const Grid&) = delete;
+    Grid& operator=(const Grid&) = delete;
+    Grid(Grid&&) = delete;
+    Grid& operator=(Grid&&) = delete;
+
+    // Repaints only the cells changed since the last call, then blits the cached canvas
+    void draw(sf::RenderWindow& window);
+    bool isDirty() const { return canvasStale || !dirtyNodes.empty(); }
     void handleMouseClick(const sf::Event::MouseButtonPressed& mouseEvent, sf::RenderWindow& window);
     void reset();
 
@@ -22,8 +30,14 @@ public:
 private:
     int rows, cols;
     int cellWidth, cellHeight;
+    std::vector<Node*> dirtyNodes;
     std::vector<std::vector<Node>> grid;
 
+    // Retained render of the grid; window buffers are not preserved across display()
+    sf::RenderTexture canvas;
+    sf::Sprite canvasSprite;
+    bool canvasStale = true;
+
     sf::Vector2i startPos{-1, -1};
     sf::Vector2i endPos{-1, -1};
     bool placingStart = true;
@@ -2,6 +2,7 @@
 #define NODE_H
 
 #include <SFML/Graphics.hpp>
+#include <vector>
 
 enum class NodeType {
     EMPTY,
@@ -18,7 +19,7 @@ public:
     Node(int gridX, int gridY, int width, int height);
 
     // draw must be const so it can be called on const references
-    void draw(sf::RenderWindow& window) const;
+    void draw(sf::RenderTarget& target) const;
     void setType(NodeType type);
     NodeType getType() const;
     void setG(float val) { g = val; updateF(); }
@@ -35,6 +36,10 @@ public:
     int getGridX() const { return gridX; }
     int getGridY() const { return gridY; }
 
+    // Dirty tracking: setType queues this node on the owner's list once per frame
+    void setDirtyList(std::vector<Node*>* list) { dirtyList = list; }
+    void markClean() { dirty = false; }
+
 
 private:
     int gridX, gridY;
@@ -43,6 +48,8 @@ private:
     sf::RectangleShape shape;
     float f = 0, g = 0, h = 0;
     Node* parent = nullptr;
+    std::vector<Node*>* dirtyList = nullptr;
+    bool dirty = false;
     void updateColor();
     void updateF() { f = g + h; }
 };
@@ -0,0 +1,66 @@
+#ifndef PATHFINDER_H
+#define PATHFINDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "tilemap.h"
+
+enum class Algorithm { ASTAR, DIJKSTRA, BFS, DFS };
+
+struct SearchResult {
+    bool found = false;
+    bool limitReached = false;          // gave up at the expansion limit, goal may still be reachable
+    std::vector<Cell> path;             // start to goal inclusive, empty if not found
+    std::size_t expanded = 0;           // nodes taken off the open set
+};
+
+// Headless counterparts of Grid's solvers, reading walls from a TileMap through a TileCursor.
+// Search state lives in hash maps keyed by cell, so memory scales with the area explored rather
+// than the map size; the buffers are kept between calls so repeated queries don't reallocate.
+class Pathfinder {
+public:
+    explicit Pathfinder(TileMap& map);
+
+    bool run(Algorithm algorithm, Cell start, Cell goal, SearchResult& result);
+
+    // Give up after this many expansions (0 = no limit)
+    void setExpandLimit(std::size_t limit) { expandLimit = limit; }
+
+    // Free the search buffers instead of keeping them warm, e.g. after std::bad_alloc
+    void releaseBuffers();
+
+private:
+    struct OpenEntry {
+        float f;
+        float g;
+        std::uint64_t key;
+        // Ties on f go to the deeper entry, so open ground doesn't expand the whole bounding box
+        bool operator>(const OpenEntry& other) const {
+            return f > other.f || (f == other.f && g < other.g);
+        }
+    };
+
+    TileMap& map;
+    std::size_t expandLimit = 0;
+
+    std::unordered_map<std::uint64_t, std::uint64_t> parents;  // cell -> cell it was reached from
+    std::unordered_map<std::uint64_t, float> costs;            // best g seen (A*/Dijkstra)
+    std::vector<OpenEntry> heap;
+    std::vector<std::uint64_t> frontier;                       // BFS queue / DFS stack
+
+    std::uint64_t key(const Cell& cell) const {
+        return static_cast<std::uint64_t>(cell.y) * static_cast<std::uint64_t>(map.getWidth()) + cell.x;
+    }
+    Cell cellFromKey(std::uint64_t k) const {
+        return { static_cast<int>(k % map.getWidth()), static_cast<int>(k / map.getWidth()) };
+    }
+
+    void clearBuffers();
+    bool runBestFirst(bool useHeuristic, Cell start, Cell goal, SearchResult& result);
+    bool runUninformed(bool depthFirst, Cell start, Cell goal, SearchResult& result);
+    void buildPath(std::uint64_t startKey, std::uint64_t goalKey, SearchResult& result) const;
+};
+
+#endif // PATHFINDER_H
@@ -0,0 +1,38 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <cstddef>
+#include <string>
+
+struct ServeOptions {
+    std::string mapPath;                // TileMap file; created if width/height are also given
+    int width = 0, height = 0;          // size of a new map
+    std::size_t cacheTiles = 4096;      // resident mixed tiles for file-backed maps
+    std::size_t expandLimit = 2000000;  // per-query expansion cap (0 = no limit)
+    std::string socketPath;             // Unix domain socket; stdin/stdout when empty
+};
+
+// Parses "--serve [--map FILE] [--size WxH] [--cache N] [--limit N] [--socket PATH]"
+bool parseServeOptions(int argc, char* argv[], ServeOptions& options);
+
+// Headless query server. Loads the map once, then answers batches of line-based requests:
+//   W x y                    make (x, y) a wall
+//   E x y                    clear (x, y)
+//   Q astar|dijkstra|bfs|dfs sx sy gx gy
+//   SAVE                     sync a file-backed map to disk
+//   (blank line)             end of batch
+// Edits in a batch are coalesced and applied before its queries run. Each query answers
+// "P <expanded> <length> x y x y ...", "N <expanded>" (no path) or "L <expanded>" (gave up
+// at the expansion limit), SAVE answers "SAVED", and errors (bad requests, out-of-bounds
+// cells, wall endpoints, SAVE on an in-memory map) answer "ERR <line> <reason>".
+// Every batch ends with "OK <queries> <edits applied> <microseconds>". A batch that reaches
+// 65536 requests without a blank line is ended there with "ERR <line> batch too long" and
+// answered; the lines after it start a new batch.
+//
+// A file-backed map is updated as batches run: the TileMap writes tiles through as its cache
+// evicts them. SAVE only writes out what is still cached, so after SAVED the file holds every
+// batch answered so far. End of input, SIGINT and SIGTERM do the same before the server exits
+// (and remove the socket); a batch without its blank line yet is dropped on a signal.
+int runServer(const ServeOptions& options);
+
+#endif // SERVER_H
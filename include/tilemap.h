@@ -0,0 +1,130 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Cell {
+    int x, y;
+    bool operator==(const Cell& other) const { return x == other.x && y == other.y; }
+    bool operator!=(const Cell& other) const { return !(*this == other); }
+};
+
+// 64x64 block of cells, one bit per cell (1 = wall). Row ly is rows[ly], column lx is bit lx.
+struct Tile {
+    static constexpr int SIZE = 64;
+    std::array<std::uint64_t, SIZE> rows{};
+
+    bool isWall(int lx, int ly) const { return (rows[ly] >> lx) & 1u; }
+};
+
+enum class TileKind : std::uint8_t {
+    EMPTY,  // every cell open, backed by the shared empty tile
+    WALL,   // every cell blocked, backed by the shared wall tile
+    MIXED   // has its own bits, resident in the cache or paged out to disk
+};
+
+// Sparse wall map for very large worlds. Uniform tiles cost one byte each and share a single
+// read-only Tile; a tile only gets its own copy when an edit makes it mixed (copy-on-write).
+// With a backing file, mixed tiles are paged in on demand and kept in an LRU cache.
+//
+// File-backed maps are written as they go: a dirty tile evicted from the cache is written
+// together with its index byte, and a tile folded back to uniform updates its index byte
+// at once. Each tile on disk is therefore either its old or its new state. Edits to tiles
+// still in the cache reach the file on flush() (and in the destructor).
+class TileMap {
+public:
+    TileMap();
+    TileMap(int width, int height);     // in-memory map, all cells empty
+    ~TileMap();
+
+    TileMap(const TileMap&) = delete;
+    TileMap& operator=(const TileMap&) = delete;
+
+    // File-backed maps; cacheTiles bounds how many mixed tiles stay resident
+    bool create(const std::string& path, int width, int height, std::size_t cacheTiles);
+    bool open(const std::string& path, std::size_t cacheTiles);
+    bool flush();                       // write dirty tiles and the tile index back to disk (may throw)
+
+    bool isFileBacked() const { return file.is_open(); }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    bool isValid(int x, int y) const {
+        return x >= 0 && x < width && y >= 0 && y < height;
+    }
+
+    // On file-backed maps these may page tiles in or out, and throw std::runtime_error
+    // if that I/O fails (or std::bad_alloc if a new tile can't be allocated).
+    bool isWall(int x, int y);
+    void setWall(int x, int y, bool wall);
+
+    // Tile-level access used by TileCursor; the returned tile stays readable even if
+    // it is evicted or edited afterwards, since edits copy shared tiles first.
+    // Throws like isWall.
+    std::shared_ptr<const Tile> getTile(int tx, int ty);
+    TileKind getTileKind(int tx, int ty) const { return kinds[tileIndex(tx, ty)]; }
+
+    std::size_t residentTiles() const { return cache.size(); }
+    std::size_t memoryBytes() const;
+
+private:
+    struct CachedTile {
+        std::shared_ptr<Tile> tile;
+        bool dirty = false;
+        std::list<std::size_t>::iterator lruPos;
+    };
+
+    int width = 0, height = 0;
+    int tilesX = 0, tilesY = 0;
+    std::vector<TileKind> kinds;
+
+    std::unordered_map<std::size_t, CachedTile> cache;
+    std::list<std::size_t> lru;         // most recently used at the front
+    std::size_t cacheCapacity = 0;      // 0 = unbounded (in-memory maps)
+
+    std::fstream file;
+    std::string filePath;
+
+    static std::shared_ptr<const Tile> emptyTile();
+    static std::shared_ptr<const Tile> wallTile();
+
+    void resize(int w, int h);
+    std::size_t tileIndex(int tx, int ty) const {
+        return static_cast<std::size_t>(ty) * tilesX + tx;
+    }
+    CachedTile& fetch(std::size_t index);
+    void touch(CachedTile& entry, std::size_t index);
+    void evictIfNeeded();
+    void readTile(std::size_t index, Tile& tile);
+    void writeTile(std::size_t index, const Tile& tile);
+    void writeKind(std::size_t index);
+    void writeBack(std::size_t index, const Tile& tile);
+    bool writeHeader();
+    std::streamoff tileOffset(std::size_t index) const;
+};
+
+// Neighbour accessor for solvers: remembers the last tile it touched so lookups that stay
+// inside one 64x64 block skip the tile index and cache entirely.
+class TileCursor {
+public:
+    explicit TileCursor(TileMap& map) : map(map) {}
+
+    // Out of bounds counts as wall; both throw like TileMap::isWall
+    bool isWall(int x, int y);
+    int neighbours(const Cell& cell, Cell out[4]);  // open 4-neighbours, returns count
+
+private:
+    TileMap& map;
+    int tileX = -1, tileY = -1;
+    std::shared_ptr<const Tile> tile;
+};
+
+#endif // TILEMAP_H
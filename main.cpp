@@ -2,6 +2,8 @@
 #include <SFML/Window/Event.hpp>
 #include "include/grid.h"
 #include "include/button.h"
+#include "include/pathfinder.h"
+#include "include/server.h"
 #include <optional>
 #include <string>
 #include <iostream>
@@ -11,9 +13,19 @@ constexpr unsigned int WINDOW_HEIGHT = 800;
 constexpr int ROWS = 20;
 constexpr int COLS = 20;
 
-enum class Algorithm { ASTAR, DIJKSTRA, BFS, DFS };
+int main(int argc, char* argv[]) {
+    // Headless mode: no window, answer path queries over stdin or a Unix socket
+    if (argc > 1 && std::string(argv[1]) == "--serve") {
+        ServeOptions options;
+        if (!parseServeOptions(argc, argv, options)) {
+            std::cerr << "Usage: " << argv[0]
+                      << " --serve (--map FILE | --size WxH | --map FILE --size WxH)"
+                         " [--cache TILES] [--limit EXPANSIONS] [--socket PATH]\n";
+            return -1;
+        }
+        return runServer(options);
+    }
 
-int main() {
     sf::RenderWindow window(sf::VideoMode(sf::Vector2u(WINDOW_WIDTH, WINDOW_HEIGHT)), "Pathfinding Visualizer");
     window.setFramerateLimit(60);
 
@@ -37,16 +49,34 @@ int main() {
     Button resetBtn("Reset", {490, 700}, {100, 30}, font);
     Button quitBtn("Quit", {600, 700}, {80, 30}, font);
 
+    Button* buttons[] = { &aStarBtn, &dijkstraBtn, &bfsBtn, &dfsBtn, &runBtn, &resetBtn, &quitBtn };
+
+    // Static text is built once; its glyph geometry stays cached between frames
+    sf::Text noPathText(font, "No path found", 20);
+    noPathText.setPosition({10.f, 10.f});
+    noPathText.setFillColor(sf::Color::Red);
+
     // Set default selected algorithm button
     aStarBtn.setSelected(true);
 
+    bool needsRedraw = true;
+
     while (window.isOpen()) {
-        std::optional<sf::Event> maybeEvent;
-        while ((maybeEvent = window.pollEvent())) {
+        // Block until something happens, then drain whatever else is queued. Not every
+        // platform reports an uncovered window, so a quiet second also triggers a repaint.
+        std::optional<sf::Event> maybeEvent = window.waitEvent(sf::seconds(1));
+        if (!maybeEvent)
+            needsRedraw = true;
+
+        for (; maybeEvent; maybeEvent = window.pollEvent()) {
             const sf::Event& event = *maybeEvent;
+            const bool wasPathNotFound = pathNotFound;
 
             if (event.is<sf::Event::Closed>()) {
                 window.close();
+            } else if (event.is<sf::Event::Resized>() || event.is<sf::Event::FocusGained>()) {
+                // Window contents may have been lost while hidden or resized
+                needsRedraw = true;
             } else if (event.is<sf::Event::MouseButtonPressed>()) {
                 if (auto* mbp = event.getIf<sf::Event::MouseButtonPressed>()) {
                     sf::Vector2i mousePos = { mbp->position.x, mbp->position.y };
@@ -89,6 +119,8 @@ int main() {
                                 pathNotFound = !grid.runDFS(window);
                                 break;
                         }
+                        // The animation drew over the window without the buttons
+                        needsRedraw = true;
                     } else if (resetBtn.isHovered(mousePos)) {
                         grid.reset();
                         pathNotFound = false;
@@ -113,28 +145,36 @@ int main() {
                     }
                 }
             }
+
+            if (pathNotFound != wasPathNotFound)
+                needsRedraw = true;
         }
 
+        if (!window.isOpen())
+            break;
+
+        for (const Button* button : buttons)
+            needsRedraw = needsRedraw || button->isDirty();
+
+        // Nothing visible changed (e.g. plain mouse movement): skip the frame entirely
+        if (!needsRedraw && !grid.isDirty())
+            continue;
+
+        // The grid canvas only repaints dirty cells; compositing it is a single quad
         window.clear(sf::Color::Black);
         grid.draw(window);
 
         // Draw buttons
-        aStarBtn.draw(window);
-        dijkstraBtn.draw(window);
-        bfsBtn.draw(window);
-        dfsBtn.draw(window);
-        runBtn.draw(window);
-        resetBtn.draw(window);
-        quitBtn.draw(window);
-
-        if (pathNotFound) {
-            sf::Text noPathText(font, "No path found", 20);
-            noPathText.setPosition({10.f, 10.f});
-            noPathText.setFillColor(sf::Color::Red);
-            window.draw(noPathText);
+        for (Button* button : buttons) {
+            button->draw(window);
+            button->markClean();
         }
 
+        if (pathNotFound)
+            window.draw(noPathText);
+
         window.display();
+        needsRedraw = false;
     }
 
     return 0;
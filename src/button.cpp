@@ -38,7 +38,11 @@ bool Button::isClicked(const sf::Vector2i& mousePos) const {
 }
 
 void Button::setSelected(bool selected) {
+    if (isSelected == selected)
+        return;
+
     isSelected = selected;
+    dirty = true;
     updateAppearance();
 }
 
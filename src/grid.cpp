@@ -10,21 +10,40 @@ Grid::Grid(int rows, int cols, int windowWidth, int windowHeight)
 , cols(cols)
 , cellWidth(windowWidth / cols)
 , cellHeight(windowHeight / rows)
+, canvas(sf::Vector2u(cols * cellWidth, rows * cellHeight))
+, canvasSprite(canvas.getTexture())
 {
     grid.resize(rows, std::vector<Node>(cols));
     for (int r = 0; r < rows; ++r) {
         for (int c = 0; c < cols; ++c) {
             grid[r][c] = Node(c, r, cellWidth, cellHeight);
+            grid[r][c].setDirtyList(&dirtyNodes);
         }
     }
 }
 
-void Grid::draw(sf::RenderWindow& window) const {
-    for (const auto& row : grid) {
-        for (const auto& node : row) {
-            node.draw(window);
+void Grid::draw(sf::RenderWindow& window) {
+    if (canvasStale) {
+        canvas.clear(sf::Color::Black);
+        for (auto& row : grid) {
+            for (auto& node : row) {
+                node.draw(canvas);
+                node.markClean();
+            }
+        }
+        dirtyNodes.clear();
+        canvasStale = false;
+        canvas.display();
+    } else if (!dirtyNodes.empty()) {
+        for (Node* node : dirtyNodes) {
+            node->draw(canvas);
+            node->markClean();
         }
+        dirtyNodes.clear();
+        canvas.display();
     }
+
+    window.draw(canvasSprite);
 }
 void delay(int milliseconds);
 
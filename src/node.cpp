@@ -12,13 +12,21 @@ Node::Node(int gridX, int gridY, int width, int height)
     updateColor();
 }
 
-void Node::draw(sf::RenderWindow& window) const {
-    window.draw(shape);
+void Node::draw(sf::RenderTarget& target) const {
+    target.draw(shape);
 }
 
 void Node::setType(NodeType newType) {
+    if (type == newType)
+        return;
+
     type = newType;
     updateColor();
+
+    if (dirtyList && !dirty) {
+        dirty = true;
+        dirtyList->push_back(this);
+    }
 }
 
 NodeType Node::getType() const {
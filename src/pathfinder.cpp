@@ -0,0 +1,162 @@
+#include "../include/pathfinder.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+Pathfinder::Pathfinder(TileMap& map)
+: map(map)
+{}
+
+namespace {
+
+// clear() walks the whole bucket array, which never shrinks. After one huge search that would
+// make every later small query pay for it, so oversized tables are dropped instead.
+template <typename Map>
+void clearOrShrink(Map& table) {
+    constexpr std::size_t MIN_BUCKETS_TO_SHRINK = 1 << 16;
+    if (table.bucket_count() > MIN_BUCKETS_TO_SHRINK && table.size() * 8 < table.bucket_count())
+        table = Map{};
+    else
+        table.clear();
+}
+
+} // namespace
+
+void Pathfinder::clearBuffers() {
+    // A warm Pathfinder keeps bucket arrays and vector capacity sized for its recent queries
+    clearOrShrink(parents);
+    clearOrShrink(costs);
+    heap.clear();
+    frontier.clear();
+}
+
+void Pathfinder::releaseBuffers() {
+    std::unordered_map<std::uint64_t, std::uint64_t>().swap(parents);
+    std::unordered_map<std::uint64_t, float>().swap(costs);
+    std::vector<OpenEntry>().swap(heap);
+    std::vector<std::uint64_t>().swap(frontier);
+}
+
+bool Pathfinder::run(Algorithm algorithm, Cell start, Cell goal, SearchResult& result) {
+    result.found = false;
+    result.limitReached = false;
+    result.path.clear();
+    result.expanded = 0;
+
+    if (!map.isValid(start.x, start.y) || !map.isValid(goal.x, goal.y))
+        return false;
+    if (map.isWall(start.x, start.y) || map.isWall(goal.x, goal.y))
+        return false;
+
+    clearBuffers();
+    switch (algorithm) {
+        case Algorithm::ASTAR:    return runBestFirst(true, start, goal, result);
+        case Algorithm::DIJKSTRA: return runBestFirst(false, start, goal, result);
+        case Algorithm::BFS:      return runUninformed(false, start, goal, result);
+        case Algorithm::DFS:      return runUninformed(true, start, goal, result);
+    }
+    return false;
+}
+
+bool Pathfinder::runBestFirst(bool useHeuristic, Cell start, Cell goal, SearchResult& result) {
+    auto heuristic = [&](const Cell& c) {
+        return useHeuristic ? static_cast<float>(std::abs(c.x - goal.x) + std::abs(c.y - goal.y)) : 0.f;
+    };
+
+    TileCursor cursor(map);
+    const std::uint64_t startKey = key(start);
+    const std::uint64_t goalKey = key(goal);
+
+    costs[startKey] = 0;
+    parents[startKey] = startKey;
+    heap.push_back({ heuristic(start), 0, startKey });
+
+    Cell neighbours[4];
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<OpenEntry>());
+        OpenEntry current = heap.back();
+        heap.pop_back();
+
+        // Stale entry: a cheaper route to this cell was pushed later
+        if (current.g > costs[current.key])
+            continue;
+
+        ++result.expanded;
+        if (current.key == goalKey) {
+            buildPath(startKey, goalKey, result);
+            return true;
+        }
+        if (expandLimit && result.expanded >= expandLimit) {
+            result.limitReached = true;
+            break;
+        }
+
+        Cell cell = cellFromKey(current.key);
+        int count = cursor.neighbours(cell, neighbours);
+        for (int i = 0; i < count; ++i) {
+            std::uint64_t nk = key(neighbours[i]);
+            float tentativeG = current.g + 1;  // edge weight = 1
+
+            auto it = costs.find(nk);
+            if (it == costs.end() || tentativeG < it->second) {
+                costs[nk] = tentativeG;
+                parents[nk] = current.key;
+                heap.push_back({ tentativeG + heuristic(neighbours[i]), tentativeG, nk });
+                std::push_heap(heap.begin(), heap.end(), std::greater<OpenEntry>());
+            }
+        }
+    }
+
+    return false;
+}
+
+bool Pathfinder::runUninformed(bool depthFirst, Cell start, Cell goal, SearchResult& result) {
+    TileCursor cursor(map);
+    const std::uint64_t startKey = key(start);
+    const std::uint64_t goalKey = key(goal);
+
+    parents[startKey] = startKey;
+    frontier.push_back(startKey);
+    std::size_t head = 0;  // BFS reads from head, DFS pops from the back
+
+    Cell neighbours[4];
+    while (depthFirst ? !frontier.empty() : head < frontier.size()) {
+        std::uint64_t current;
+        if (depthFirst) {
+            current = frontier.back();
+            frontier.pop_back();
+        } else {
+            current = frontier[head++];
+        }
+
+        ++result.expanded;
+        if (current == goalKey) {
+            buildPath(startKey, goalKey, result);
+            return true;
+        }
+        if (expandLimit && result.expanded >= expandLimit) {
+            result.limitReached = true;
+            break;
+        }
+
+        int count = cursor.neighbours(cellFromKey(current), neighbours);
+        for (int i = 0; i < count; ++i) {
+            std::uint64_t nk = key(neighbours[i]);
+            // Mark on push like Grid::runBFS / Grid::runDFS
+            if (parents.emplace(nk, current).second)
+                frontier.push_back(nk);
+        }
+    }
+
+    return false;
+}
+
+void Pathfinder::buildPath(std::uint64_t startKey, std::uint64_t goalKey, SearchResult& result) const {
+    result.found = true;
+    for (std::uint64_t k = goalKey; ; k = parents.at(k)) {
+        result.path.push_back(cellFromKey(k));
+        if (k == startKey)
+            break;
+    }
+    std::reverse(result.path.begin(), result.path.end());
+}
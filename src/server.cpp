@@ -0,0 +1,591 @@
+#include "../include/server.h"
+#include "../include/pathfinder.h"
+#include "../include/tilemap.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+bool parseAlgorithm(const std::string& name, Algorithm& algorithm) {
+    if (name == "astar")    { algorithm = Algorithm::ASTAR; return true; }
+    if (name == "dijkstra") { algorithm = Algorithm::DIJKSTRA; return true; }
+    if (name == "bfs")      { algorithm = Algorithm::BFS; return true; }
+    if (name == "dfs")      { algorithm = Algorithm::DFS; return true; }
+    return false;
+}
+
+// True once only whitespace is left, so "W 3 3 extra" or "10x10junk" are rejected
+bool atEnd(std::istringstream& in) {
+    in >> std::ws;
+    return in.eof();
+}
+
+// Reads a whole non-negative number; a leading '-' would otherwise wrap around to a huge size_t
+bool parseCount(const char* text, std::size_t& value) {
+    std::istringstream in(text);
+    in >> std::ws;
+    if (in.peek() == '-')
+        return false;
+    return (in >> value) && atEnd(in);
+}
+
+// Set by SIGINT/SIGTERM. The handlers are installed without SA_RESTART, so a blocking read
+// on stdin or a poll() wakes up with EINTR and the serve loop sees the flag.
+volatile std::sig_atomic_t stopRequested = 0;
+#ifndef _WIN32
+int stopPipe[2] = { -1, -1 };  // self-pipe so the poll loop can't sleep through a signal
+
+void requestStop(int) {
+    stopRequested = 1;
+    if (stopPipe[1] >= 0) {
+        int savedErrno = errno;
+        [[maybe_unused]] ssize_t n = ::write(stopPipe[1], "x", 1);
+        errno = savedErrno;
+    }
+}
+
+void installStopHandlers() {
+    struct sigaction action{};
+    action.sa_handler = requestStop;
+    sigemptyset(&action.sa_mask);
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+}
+#else
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+void installStopHandlers() {
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+}
+#endif
+
+// One client's view of the server: its pending batch plus a Pathfinder whose search
+// buffers stay allocated between queries.
+class Session {
+public:
+    Session(TileMap& map, std::size_t expandLimit)
+    : map(map)
+    , pathfinder(map)
+    {
+        pathfinder.setExpandLimit(expandLimit);
+    }
+
+    // Longest batch in requests (distinct edited cells plus everything else); a client that
+    // never sends the blank line gets its batch ended here instead of growing it forever
+    static constexpr std::size_t MAX_BATCH_REQUESTS = 65536;
+
+    // Returns true once the line closed a batch; the batch response is appended to out
+    bool feed(const std::string& line, std::string& out) {
+        ++lineNumber;
+        if (line.empty() || line == "\r") {
+            runBatch(out);
+            return true;
+        }
+        parse(line);
+        if (items.size() + pendingEdits.size() >= MAX_BATCH_REQUESTS) {
+            addError("batch too long, ended here");
+            runBatch(out);
+            return true;
+        }
+        return false;
+    }
+
+    // End of input: answer whatever is still pending
+    void finish(std::string& out) {
+        if (!items.empty() || !pendingEdits.empty())
+            runBatch(out);
+    }
+
+private:
+    enum class ItemType { QUERY, SAVE, FAILED };
+
+    struct Item {
+        ItemType type = ItemType::QUERY;
+        Algorithm algorithm = Algorithm::ASTAR;
+        Cell start{0, 0}, goal{0, 0};
+        std::string error;
+        std::size_t line = 0;
+    };
+
+    struct PendingEdit {
+        bool wall;
+        std::size_t line;
+    };
+
+    TileMap& map;
+    Pathfinder pathfinder;
+    SearchResult result;
+    std::size_t lineNumber = 0;
+
+    std::unordered_map<std::uint64_t, PendingEdit> pendingEdits;  // last edit to a cell wins
+    std::vector<std::pair<Cell, PendingEdit>> orderedEdits;      // pendingEdits in tile order
+    std::vector<Item> items;
+
+    void addError(const std::string& reason) {
+        Item item;
+        item.type = ItemType::FAILED;
+        item.error = std::to_string(lineNumber) + " " + reason;
+        items.push_back(std::move(item));
+    }
+
+    void parse(const std::string& line) {
+        std::istringstream in(line);
+        std::string command;
+        in >> command;
+
+        if (command == "W" || command == "E") {
+            int x, y;
+            if (!(in >> x >> y) || !atEnd(in))
+                return addError("expected: " + command + " x y");
+            if (!map.isValid(x, y))
+                return addError("cell out of bounds");
+            std::uint64_t key = static_cast<std::uint64_t>(y) * static_cast<std::uint64_t>(map.getWidth()) + x;
+            pendingEdits[key] = { command == "W", lineNumber };
+        } else if (command == "Q") {
+            Item item;
+            item.line = lineNumber;
+            std::string name;
+            if (!(in >> name >> item.start.x >> item.start.y >> item.goal.x >> item.goal.y) || !atEnd(in))
+                return addError("expected: Q algorithm sx sy gx gy");
+            if (!parseAlgorithm(name, item.algorithm))
+                return addError("unknown algorithm " + name);
+            if (!map.isValid(item.start.x, item.start.y) || !map.isValid(item.goal.x, item.goal.y))
+                return addError("cell out of bounds");
+            items.push_back(item);
+        } else if (command == "SAVE") {
+            if (!atEnd(in))
+                return addError("expected: SAVE");
+            Item item;
+            item.type = ItemType::SAVE;
+            item.line = lineNumber;
+            items.push_back(item);
+        } else {
+            addError("unknown command " + command);
+        }
+    }
+
+    // A failing query answers ERR instead of taking the whole server down
+    void runQuery(const Item& item, std::string& out) {
+        try {
+            // Checked here rather than in parse since the batch's edits may have changed it
+            if (map.isWall(item.start.x, item.start.y) || map.isWall(item.goal.x, item.goal.y)) {
+                out += "ERR " + std::to_string(item.line) + " endpoint is a wall\n";
+                return;
+            }
+            if (pathfinder.run(item.algorithm, item.start, item.goal, result)) {
+                out += "P " + std::to_string(result.expanded) + " " + std::to_string(result.path.size());
+                for (const Cell& cell : result.path)
+                    out += " " + std::to_string(cell.x) + " " + std::to_string(cell.y);
+                out += "\n";
+            } else {
+                out += (result.limitReached ? "L " : "N ") + std::to_string(result.expanded) + "\n";
+            }
+        } catch (const std::bad_alloc&) {
+            pathfinder.releaseBuffers();
+            out += "ERR " + std::to_string(item.line) + " out of memory\n";
+        } catch (const std::runtime_error& e) {
+            out += "ERR " + std::to_string(item.line) + " " + e.what() + "\n";
+        }
+    }
+
+    void runSave(const Item& item, std::string& out) {
+        if (!map.isFileBacked()) {
+            out += "ERR " + std::to_string(item.line) + " map is not file-backed\n";
+            return;
+        }
+        try {
+            if (map.flush()) {
+                out += "SAVED\n";
+                return;
+            }
+        } catch (const std::runtime_error&) {
+            // reported below like a failed header write
+        }
+        out += "ERR " + std::to_string(item.line) + " save failed\n";
+    }
+
+    void runBatch(std::string& out) {
+        auto begin = std::chrono::steady_clock::now();
+
+        // Apply edits tile by tile rather than in hash order, so a file-backed map pages
+        // each tile in once instead of thrashing its cache on scattered edits
+        orderedEdits.clear();
+        for (const auto& [key, edit] : pendingEdits) {
+            Cell cell{ static_cast<int>(key % map.getWidth()), static_cast<int>(key / map.getWidth()) };
+            orderedEdits.push_back({ cell, edit });
+        }
+        std::sort(orderedEdits.begin(), orderedEdits.end(), [](const auto& a, const auto& b) {
+            int aty = a.first.y / Tile::SIZE, bty = b.first.y / Tile::SIZE;
+            if (aty != bty)
+                return aty < bty;
+            int atx = a.first.x / Tile::SIZE, btx = b.first.x / Tile::SIZE;
+            if (atx != btx)
+                return atx < btx;
+            return a.first.y != b.first.y ? a.first.y < b.first.y : a.first.x < b.first.x;
+        });
+
+        std::size_t applied = 0;
+        for (const auto& [cell, edit] : orderedEdits) {
+            int x = cell.x, y = cell.y;
+            try {
+                if (map.isWall(x, y) != edit.wall) {
+                    map.setWall(x, y, edit.wall);
+                    ++applied;
+                }
+            } catch (const std::bad_alloc&) {
+                out += "ERR " + std::to_string(edit.line) + " out of memory\n";
+            } catch (const std::runtime_error& e) {
+                out += "ERR " + std::to_string(edit.line) + " " + e.what() + "\n";
+            }
+        }
+        pendingEdits.clear();
+        orderedEdits.clear();
+
+        std::size_t queries = 0;
+        for (const Item& item : items) {
+            switch (item.type) {
+                case ItemType::QUERY:
+                    ++queries;
+                    runQuery(item, out);
+                    break;
+                case ItemType::SAVE:
+                    runSave(item, out);
+                    break;
+                case ItemType::FAILED:
+                    out += "ERR " + item.error + "\n";
+                    break;
+            }
+        }
+        items.clear();
+
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - begin).count();
+        out += "OK " + std::to_string(queries) + " " + std::to_string(applied) + " " + std::to_string(micros) + "\n";
+    }
+};
+
+int serveStdin(TileMap& map, const ServeOptions& options) {
+    Session session(map, options.expandLimit);
+    std::string line, out;
+    while (!stopRequested && std::getline(std::cin, line)) {
+        if (session.feed(line, out)) {
+            std::cout << out << std::flush;
+            out.clear();
+        }
+    }
+    // Stopped by a signal: drop the unfinished batch rather than run half of it
+    if (!stopRequested)
+        session.finish(out);
+    std::cout << out << std::flush;
+    return 0;
+}
+
+#ifndef _WIN32
+// Stop reading from a client while this much of its output is still unsent, so a client
+// that pipelines requests without reading replies can't grow our buffers without bound
+constexpr std::size_t MAX_PENDING_OUTPUT = 4 * 1024 * 1024;
+// Longest request line accepted; anything longer is treated as a broken client
+constexpr std::size_t MAX_LINE_LENGTH = 64 * 1024;
+
+struct Connection {
+    int fd = -1;
+    std::unique_ptr<Session> session;
+    std::string input;
+    std::string output;
+    std::size_t outputSent = 0;
+    bool peerClosed = false;
+
+    std::size_t pendingOutput() const { return output.size() - outputSent; }
+};
+
+bool setNonBlocking(int fd) {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Runs buffered request lines until the output backlog is full; the rest waits for POLLOUT
+void processInput(Connection& conn) {
+    std::size_t start = 0, end;
+    while (conn.pendingOutput() < MAX_PENDING_OUTPUT
+           && (end = conn.input.find('\n', start)) != std::string::npos) {
+        conn.session->feed(conn.input.substr(start, end - start), conn.output);
+        start = end + 1;
+    }
+    conn.input.erase(0, start);
+}
+
+// Peer hung up: once every complete line has run, treat the remainder as a last line
+void finishInput(Connection& conn) {
+    if (conn.input.find('\n') != std::string::npos)
+        return;
+    if (!conn.input.empty())
+        conn.session->feed(conn.input, conn.output);
+    conn.input.clear();
+    conn.session->finish(conn.output);
+}
+
+// Returns false when the connection should be dropped
+bool readFrom(Connection& conn, char* buffer, std::size_t size) {
+    while (true) {
+        ssize_t n = ::read(conn.fd, buffer, size);
+        if (n > 0) {
+            conn.input.append(buffer, static_cast<std::size_t>(n));
+            processInput(conn);
+            // Leftover complete lines mean we're backlogged; the rest stays in the socket
+            if (conn.input.find('\n') != std::string::npos)
+                return true;
+            if (conn.input.size() > MAX_LINE_LENGTH)
+                return false;
+            continue;
+        }
+        if (n == 0) {
+            conn.peerClosed = true;
+            processInput(conn);
+            finishInput(conn);
+            return true;
+        }
+        if (errno == EINTR)
+            continue;
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+}
+
+// Returns false when the connection should be dropped
+bool flushTo(Connection& conn) {
+    while (conn.pendingOutput() > 0) {
+        ssize_t n = ::write(conn.fd, conn.output.data() + conn.outputSent, conn.pendingOutput());
+        if (n > 0) {
+            conn.outputSent += static_cast<std::size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return true;
+        return false;
+    }
+    conn.output.clear();
+    conn.outputSent = 0;
+    return true;
+}
+
+int serveSocket(TileMap& map, const ServeOptions& options) {
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::cerr << "socket: " << std::strerror(errno) << "\n";
+        return -1;
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (options.socketPath.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Socket path too long: " << options.socketPath << "\n";
+        ::close(listener);
+        return -1;
+    }
+    std::strcpy(addr.sun_path, options.socketPath.c_str());
+    ::unlink(options.socketPath.c_str());
+
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0
+        || ::listen(listener, SOMAXCONN) < 0 || !setNonBlocking(listener)) {
+        std::cerr << "bind/listen " << options.socketPath << ": " << std::strerror(errno) << "\n";
+        ::close(listener);
+        return -1;
+    }
+
+    // A client hanging up mid-reply should only drop that client
+    std::signal(SIGPIPE, SIG_IGN);
+
+    if (::pipe(stopPipe) < 0 || !setNonBlocking(stopPipe[0]) || !setNonBlocking(stopPipe[1])) {
+        std::cerr << "pipe: " << std::strerror(errno) << "\n";
+        ::close(listener);
+        ::unlink(options.socketPath.c_str());
+        return -1;
+    }
+
+    // Single-threaded poll loop: batches from different clients never interleave,
+    // so each batch sees the map exactly as the previous batch left it. Client sockets
+    // are non-blocking and replies are buffered per connection, so a client that stops
+    // reading only stalls itself.
+    std::vector<Connection> connections;
+    std::vector<pollfd> fds;
+    char buffer[64 * 1024];
+
+    int status = 0;
+    while (!stopRequested) {
+        fds.clear();
+        fds.push_back({stopPipe[0], POLLIN, 0});
+        fds.push_back({listener, POLLIN, 0});
+        for (const Connection& conn : connections) {
+            short events = 0;
+            if (!conn.peerClosed && conn.pendingOutput() < MAX_PENDING_OUTPUT)
+                events |= POLLIN;
+            if (conn.pendingOutput() > 0)
+                events |= POLLOUT;
+            fds.push_back({conn.fd, events, 0});
+        }
+
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            std::cerr << "poll: " << std::strerror(errno) << "\n";
+            status = -1;
+            break;
+        }
+        if (fds[0].revents & POLLIN)
+            break;
+
+        // Walk clients back to front so closing one doesn't shift the others' pollfd slots
+        for (std::size_t i = connections.size(); i-- > 0; ) {
+            short revents = fds[i + 2].revents;
+            Connection& conn = connections[i];
+            bool keep = true;
+
+            if (revents & POLLERR) {
+                keep = false;
+            } else if ((revents & (POLLIN | POLLHUP)) && !conn.peerClosed
+                       && conn.pendingOutput() < MAX_PENDING_OUTPUT) {
+                keep = readFrom(conn, buffer, sizeof(buffer));
+            }
+
+            if (keep && conn.pendingOutput() > 0)
+                keep = flushTo(conn);
+
+            // Backlog drained: pick up requests that were held back
+            if (keep && conn.pendingOutput() == 0 && conn.input.find('\n') != std::string::npos) {
+                processInput(conn);
+                if (conn.peerClosed)
+                    finishInput(conn);
+                keep = flushTo(conn);
+            }
+
+            if (!keep || (conn.peerClosed && conn.pendingOutput() == 0
+                          && conn.input.find('\n') == std::string::npos)) {
+                ::close(conn.fd);
+                connections.erase(connections.begin() + static_cast<std::ptrdiff_t>(i));
+            }
+        }
+
+        if (fds[1].revents & POLLIN) {
+            int client;
+            while ((client = ::accept(listener, nullptr, nullptr)) >= 0) {
+                if (!setNonBlocking(client)) {
+                    ::close(client);
+                    continue;
+                }
+                Connection conn;
+                conn.fd = client;
+                conn.session = std::make_unique<Session>(map, options.expandLimit);
+                connections.push_back(std::move(conn));
+            }
+        }
+    }
+
+    // Replies already produced are not waited for; unfinished batches are dropped
+    for (const Connection& conn : connections)
+        ::close(conn.fd);
+    ::close(listener);
+    ::unlink(options.socketPath.c_str());
+    for (int& fd : stopPipe) {
+        ::close(fd);
+        fd = -1;
+    }
+    return status;
+}
+#else
+int serveSocket(TileMap&, const ServeOptions&) {
+    std::cerr << "--socket is not supported on this platform; use stdin/stdout\n";
+    return -1;
+}
+#endif
+
+} // namespace
+
+bool parseServeOptions(int argc, char* argv[], ServeOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--serve") {
+            continue;
+        } else if (arg == "--map" && hasValue) {
+            options.mapPath = argv[++i];
+        } else if (arg == "--size" && hasValue) {
+            char x;
+            std::istringstream in(argv[++i]);
+            if (!(in >> options.width >> x >> options.height) || x != 'x' || !atEnd(in)
+                || options.width <= 0 || options.height <= 0)
+                return false;
+        } else if (arg == "--cache" && hasValue) {
+            if (!parseCount(argv[++i], options.cacheTiles))
+                return false;
+        } else if (arg == "--limit" && hasValue) {
+            if (!parseCount(argv[++i], options.expandLimit))
+                return false;
+        } else if (arg == "--socket" && hasValue) {
+            options.socketPath = argv[++i];
+        } else {
+            return false;
+        }
+    }
+
+    // Need either an existing map file or a size for a new one
+    return !options.mapPath.empty() || options.width > 0;
+}
+
+int runServer(const ServeOptions& options) {
+    std::unique_ptr<TileMap> map;
+    if (options.mapPath.empty()) {
+        map = std::make_unique<TileMap>(options.width, options.height);
+    } else {
+        map = std::make_unique<TileMap>();
+        bool loaded = options.width > 0
+            ? map->create(options.mapPath, options.width, options.height, options.cacheTiles)
+            : map->open(options.mapPath, options.cacheTiles);
+        if (!loaded) {
+            std::cerr << "Failed to load map " << options.mapPath << "\n";
+            return -1;
+        }
+    }
+
+    installStopHandlers();
+    int status = options.socketPath.empty()
+        ? serveStdin(*map, options)
+        : serveSocket(*map, options);
+
+    // Same as a final SAVE, so a clean shutdown never leaves edits only in the cache
+    if (map->isFileBacked()) {
+        bool saved = false;
+        try {
+            saved = map->flush();
+        } catch (const std::runtime_error&) {
+        }
+        if (!saved) {
+            std::cerr << "Failed to save map " << options.mapPath << "\n";
+            return -1;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,369 @@
+#include "../include/tilemap.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// On-disk layout: header, one TileKind byte per tile, then a fixed 512-byte slot per tile.
+// Slots of uniform tiles are never written, so the file stays sparse on most filesystems.
+// Integers are stored in native byte order.
+constexpr char MAGIC[4] = {'P', 'F', 'T', 'M'};
+constexpr std::uint32_t VERSION = 1;
+
+struct FileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::int32_t width;
+    std::int32_t height;
+    std::uint32_t tileSize;
+};
+
+constexpr std::streamoff HEADER_SIZE = sizeof(FileHeader);
+
+} // namespace
+
+TileMap::TileMap() = default;
+
+TileMap::TileMap(int width, int height) {
+    resize(width, height);
+}
+
+TileMap::~TileMap() {
+    if (!file.is_open())
+        return;
+
+    try {
+        flush();
+    } catch (const std::exception&) {
+        // Nothing sensible to do with a write error during teardown
+    }
+}
+
+std::shared_ptr<const Tile> TileMap::emptyTile() {
+    static const std::shared_ptr<const Tile> tile = std::make_shared<Tile>();
+    return tile;
+}
+
+std::shared_ptr<const Tile> TileMap::wallTile() {
+    static const std::shared_ptr<const Tile> tile = [] {
+        auto t = std::make_shared<Tile>();
+        t->rows.fill(~std::uint64_t{0});
+        return t;
+    }();
+    return tile;
+}
+
+void TileMap::resize(int w, int h) {
+    width = w;
+    height = h;
+    tilesX = (w + Tile::SIZE - 1) / Tile::SIZE;
+    tilesY = (h + Tile::SIZE - 1) / Tile::SIZE;
+    kinds.assign(static_cast<std::size_t>(tilesX) * tilesY, TileKind::EMPTY);
+    cache.clear();
+    lru.clear();
+}
+
+bool TileMap::create(const std::string& path, int w, int h, std::size_t cacheTiles) {
+    if (file.is_open())
+        flush();
+    file.close();
+
+    file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+
+    filePath = path;
+    resize(w, h);
+    cacheCapacity = cacheTiles;
+    return writeHeader();
+}
+
+bool TileMap::open(const std::string& path, std::size_t cacheTiles) {
+    if (file.is_open())
+        flush();
+    file.close();
+
+    file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file)
+        return false;
+
+    FileHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+        || header.version != VERSION || header.tileSize != Tile::SIZE
+        || header.width <= 0 || header.height <= 0) {
+        file.close();
+        return false;
+    }
+
+    filePath = path;
+    resize(header.width, header.height);
+    cacheCapacity = cacheTiles;
+
+    file.read(reinterpret_cast<char*>(kinds.data()), static_cast<std::streamsize>(kinds.size()));
+    if (!file) {
+        file.close();
+        return false;
+    }
+
+    // Reject corrupt or truncated files now rather than when a search pages a tile in
+    std::size_t lastMixed = 0;
+    bool anyMixed = false;
+    for (std::size_t i = 0; i < kinds.size(); ++i) {
+        if (static_cast<std::uint8_t>(kinds[i]) > static_cast<std::uint8_t>(TileKind::MIXED)) {
+            file.close();
+            return false;
+        }
+        if (kinds[i] == TileKind::MIXED) {
+            lastMixed = i;
+            anyMixed = true;
+        }
+    }
+
+    file.seekg(0, std::ios::end);
+    std::streamoff fileSize = file.tellg();
+    std::streamoff needed = anyMixed ? tileOffset(lastMixed + 1) : tileOffset(0);
+    if (fileSize < needed) {
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+bool TileMap::flush() {
+    if (!file.is_open())
+        return true;
+
+    for (auto& [index, entry] : cache) {
+        if (entry.dirty) {
+            writeTile(index, *entry.tile);
+            entry.dirty = false;
+        }
+    }
+    return writeHeader();
+}
+
+bool TileMap::writeHeader() {
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.width = width;
+    header.height = height;
+    header.tileSize = Tile::SIZE;
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(kinds.data()), static_cast<std::streamsize>(kinds.size()));
+    file.flush();
+    return static_cast<bool>(file);
+}
+
+std::streamoff TileMap::tileOffset(std::size_t index) const {
+    return HEADER_SIZE + static_cast<std::streamoff>(kinds.size())
+        + static_cast<std::streamoff>(index) * static_cast<std::streamoff>(sizeof(Tile::rows));
+}
+
+void TileMap::readTile(std::size_t index, Tile& tile) {
+    file.seekg(tileOffset(index));
+    file.read(reinterpret_cast<char*>(tile.rows.data()), sizeof(tile.rows));
+    if (!file)
+        throw std::runtime_error("TileMap: failed to page in tile from " + filePath);
+}
+
+void TileMap::writeTile(std::size_t index, const Tile& tile) {
+    file.seekp(tileOffset(index));
+    file.write(reinterpret_cast<const char*>(tile.rows.data()), sizeof(tile.rows));
+    if (!file)
+        throw std::runtime_error("TileMap: failed to page out tile to " + filePath);
+}
+
+void TileMap::writeKind(std::size_t index) {
+    file.seekp(HEADER_SIZE + static_cast<std::streamoff>(index));
+    file.write(reinterpret_cast<const char*>(&kinds[index]), sizeof(TileKind));
+    if (!file)
+        throw std::runtime_error("TileMap: failed to update tile index in " + filePath);
+}
+
+void TileMap::writeBack(std::size_t index, const Tile& tile) {
+    // Slot first, then its index byte: a crash in between leaves the tile's previous state
+    writeTile(index, tile);
+    writeKind(index);
+    file.flush();
+}
+
+void TileMap::touch(CachedTile& entry, std::size_t index) {
+    if (entry.lruPos != lru.begin()) {
+        lru.erase(entry.lruPos);
+        lru.push_front(index);
+        entry.lruPos = lru.begin();
+    }
+}
+
+void TileMap::evictIfNeeded() {
+    if (cacheCapacity == 0 || !file.is_open())
+        return;
+
+    // Never evict the tile that was just brought in (it sits at the front)
+    while (cache.size() > cacheCapacity && cache.size() > 1) {
+        std::size_t victim = lru.back();
+        auto it = cache.find(victim);
+        if (it->second.dirty)
+            writeBack(victim, *it->second.tile);
+        lru.pop_back();
+        cache.erase(it);
+    }
+}
+
+TileMap::CachedTile& TileMap::fetch(std::size_t index) {
+    auto it = cache.find(index);
+    if (it != cache.end()) {
+        touch(it->second, index);
+        return it->second;
+    }
+
+    // Only file-backed maps ever drop mixed tiles, so a miss means it is on disk
+    auto tile = std::make_shared<Tile>();
+    readTile(index, *tile);
+
+    lru.push_front(index);
+    CachedTile& entry = cache[index];
+    entry.tile = std::move(tile);
+    entry.lruPos = lru.begin();
+    evictIfNeeded();
+    return entry;
+}
+
+std::shared_ptr<const Tile> TileMap::getTile(int tx, int ty) {
+    std::size_t index = tileIndex(tx, ty);
+    switch (kinds[index]) {
+        case TileKind::EMPTY: return emptyTile();
+        case TileKind::WALL:  return wallTile();
+        case TileKind::MIXED: break;
+    }
+    return fetch(index).tile;
+}
+
+bool TileMap::isWall(int x, int y) {
+    if (!isValid(x, y))
+        return true;
+
+    std::size_t index = tileIndex(x / Tile::SIZE, y / Tile::SIZE);
+    switch (kinds[index]) {
+        case TileKind::EMPTY: return false;
+        case TileKind::WALL:  return true;
+        case TileKind::MIXED: break;
+    }
+    return fetch(index).tile->isWall(x % Tile::SIZE, y % Tile::SIZE);
+}
+
+void TileMap::setWall(int x, int y, bool wall) {
+    if (!isValid(x, y))
+        return;
+
+    std::size_t index = tileIndex(x / Tile::SIZE, y / Tile::SIZE);
+    TileKind kind = kinds[index];
+    if ((kind == TileKind::EMPTY && !wall) || (kind == TileKind::WALL && wall))
+        return;
+
+    CachedTile* entry;
+    if (kind == TileKind::MIXED) {
+        entry = &fetch(index);
+        // A solver may still be reading this tile through a cursor; give the edit its own copy
+        if (entry->tile.use_count() > 1)
+            entry->tile = std::make_shared<Tile>(*entry->tile);
+    } else {
+        // Copy-on-write out of the shared uniform tile
+        lru.push_front(index);
+        entry = &cache[index];
+        entry->tile = std::make_shared<Tile>(kind == TileKind::WALL ? *wallTile() : *emptyTile());
+        entry->lruPos = lru.begin();
+        kinds[index] = TileKind::MIXED;
+    }
+
+    std::uint64_t& row = entry->tile->rows[y % Tile::SIZE];
+    std::uint64_t bit = std::uint64_t{1} << (x % Tile::SIZE);
+    row = wall ? (row | bit) : (row & ~bit);
+    entry->dirty = true;
+
+    // Fold the tile back into a shared one once it is uniform again
+    bool allEmpty = true, allWall = true;
+    for (std::uint64_t r : entry->tile->rows) {
+        allEmpty = allEmpty && r == 0;
+        allWall = allWall && r == ~std::uint64_t{0};
+    }
+    if (allEmpty || allWall) {
+        kinds[index] = allWall ? TileKind::WALL : TileKind::EMPTY;
+        lru.erase(entry->lruPos);
+        cache.erase(index);
+        // The on-disk slot may hold older bits; point the index past it right away
+        if (file.is_open()) {
+            writeKind(index);
+            file.flush();
+        }
+        return;
+    }
+
+    evictIfNeeded();
+}
+
+std::size_t TileMap::memoryBytes() const {
+    // Approximate: tile bits plus shared_ptr control block, hash node and LRU node per entry
+    constexpr std::size_t perTile = sizeof(Tile) + 2 * sizeof(void*)
+        + sizeof(std::pair<const std::size_t, CachedTile>) + 2 * sizeof(void*)
+        + sizeof(std::size_t) + 2 * sizeof(void*);
+    return kinds.size() * sizeof(TileKind) + cache.size() * perTile;
+}
+
+bool TileCursor::isWall(int x, int y) {
+    if (!map.isValid(x, y))
+        return true;
+
+    int tx = x / Tile::SIZE;
+    int ty = y / Tile::SIZE;
+    if (tx != tileX || ty != tileY) {
+        // Uniform tiles answer from the index alone and keep the current tile cached
+        TileKind kind = map.getTileKind(tx, ty);
+        if (kind != TileKind::MIXED)
+            return kind == TileKind::WALL;
+
+        tile = map.getTile(tx, ty);
+        tileX = tx;
+        tileY = ty;
+    }
+    return tile->isWall(x % Tile::SIZE, y % Tile::SIZE);
+}
+
+int TileCursor::neighbours(const Cell& cell, Cell out[4]) {
+    // Same order as Grid::directions (up, left, right, down)
+    static constexpr Cell directions[4] = { {0, -1}, {-1, 0}, {1, 0}, {0, 1} };
+
+    int count = 0;
+    int lx = cell.x % Tile::SIZE;
+    int ly = cell.y % Tile::SIZE;
+
+    // Cell strictly inside its tile: all four neighbours come from the same 64-bit rows
+    if (lx > 0 && lx < Tile::SIZE - 1 && ly > 0 && ly < Tile::SIZE - 1
+        && map.isValid(cell.x, cell.y)
+        && cell.x + 1 < map.getWidth() && cell.y + 1 < map.getHeight()) {
+        int tx = cell.x / Tile::SIZE;
+        int ty = cell.y / Tile::SIZE;
+        if (tx != tileX || ty != tileY) {
+            tile = map.getTile(tx, ty);
+            tileX = tx;
+            tileY = ty;
+        }
+        for (const Cell& dir : directions) {
+            if (!tile->isWall(lx + dir.x, ly + dir.y))
+                out[count++] = { cell.x + dir.x, cell.y + dir.y };
+        }
+        return count;
+    }
+
+    for (const Cell& dir : directions) {
+        int nx = cell.x + dir.x;
+        int ny = cell.y + dir.y;
+        if (!isWall(nx, ny))
+            out[count++] = { nx, ny };
+    }
+    return count;
+}